@@ -1,4 +1,4 @@
-QT       += core gui  qml quick quickwidgets
+QT       += core gui  qml quick quickwidgets network
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -21,11 +21,15 @@ CONFIG += c++11
 SOURCES += \
         main.cpp \
         mainwindow.cpp \
-        mapdata.cpp
+        mapdata.cpp \
+        maprenderer.cpp \
+        statussource.cpp
 
 HEADERS += \
         mainwindow.h \
-        mapdata.h
+        mapdata.h \
+        maprenderer.h \
+        statussource.h
 
 FORMS += \
         mainwindow.ui
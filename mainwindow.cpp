@@ -1,9 +1,12 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include "mapdata.h"
+#include "statussource.h"
+#include "maprenderer.h"
 #include <QDebug>
 #include <QVariant>
 #include <QQmlContext>
+#include <QSurfaceFormat>
 
 MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent),
     ui(new Ui::MainWindow)
@@ -12,6 +15,7 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent),
 
     // Регистрируем C++ тип в QML
     qmlRegisterType<MapData>("MapData", 1, 0, "MapData");
+    qmlRegisterType<MapRenderer>("MapData", 1, 0, "MapRenderer");
 
     // Создаем объект MapData
     MapData *mapData = new MapData(this);
@@ -25,6 +29,15 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent),
     // Подключаем сигналы MapData к слотам MainWindow
     connectMapDataSignals(mapData);
     mapData -> setSelectedRegion("11001");
+
+    // Внешний источник статусов (файл и/или локальный сокет)
+    setupStatusSource(mapData);
+
+    // Сглаживание краев регионов и обводки (MSAA), до первой отрисовки
+    QSurfaceFormat format = ui->quickWidget->format();
+    format.setSamples(4);
+    ui->quickWidget->setFormat(format);
+
     // Загружаем QML
     ui->quickWidget->setSource(QUrl("qrc:/qml/MapComponent.qml"));
     ui->quickWidget->setResizeMode(QQuickWidget::SizeRootObjectToView);
@@ -53,6 +66,26 @@ void MainWindow::connectMapDataSignals(MapData *mapData)
     connect(mapData, &MapData::regionsChanged, this, &MainWindow::onRegionsChanged);
 }
 
+void MainWindow::setupStatusSource(MapData *mapData)
+{
+    StatusSource *statusSource = new StatusSource(mapData, this);
+    connect(statusSource, &StatusSource::sourceError, this, &MainWindow::onStatusSourceError);
+
+    // Следующий пакет статусов принимается только после отрисовки кадра
+    statusSource->setRenderWindow(ui->quickWidget->quickWindow());
+
+    // Путь к файлу и имя сокета можно переопределить через переменные окружения
+    QString statusFile = qEnvironmentVariable("MAP_STATUS_FILE");
+    if (!statusFile.isEmpty()) {
+        statusSource->watchFile(statusFile);
+    }
+
+    QString statusSocket = qEnvironmentVariable("MAP_STATUS_SOCKET");
+    if (!statusSocket.isEmpty()) {
+        statusSource->listenSocket(statusSocket);
+    }
+}
+
 // Обработчик клика по региону - БЕЗ блокирующего диалога
 void MainWindow::onRegionClicked(const QString &regionId, const QString &regionName)
 {
@@ -132,3 +165,10 @@ void MainWindow::onRegionsChanged()
         ui->statusBar->showMessage(QString("Загружено регионов: %1").arg(count), 2000);
     }
 }
+
+// Обработчик ошибок источника статусов
+void MainWindow::onStatusSourceError(const QString &message)
+{
+    qWarning() << "Status source error:" << message;
+    ui->statusBar->showMessage(message, 5000);
+}
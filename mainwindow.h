@@ -4,6 +4,7 @@
 #include <QMainWindow>
 
 class MapData; // Forward declaration
+class StatusSource;
 
 namespace Ui {
 class MainWindow;
@@ -23,12 +24,14 @@ private slots:
     void onSelectedRegionChanged(const QString &regionId);
     void onRegionStatusChanged(const QString &regionId, const QString &status);
     void onRegionsChanged();
+    void onStatusSourceError(const QString &message);
 
 private:
     Ui::MainWindow *ui;
 
     // Вспомогательные методы
     void connectMapDataSignals(MapData *mapData);
+    void setupStatusSource(MapData *mapData);
 };
 
 #endif // MAINWINDOW_H
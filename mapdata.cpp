@@ -40,6 +40,7 @@ void MapData::parseGeoJSON(const QJsonDocument &doc)
     QJsonArray features = root["features"].toArray();
 
     m_regions.clear();
+    m_regionIndex.clear();
 
     qDebug() << "Начинаем парсинг GeoJSON, количество features:" << features.size();
 
@@ -109,6 +110,7 @@ void MapData::parseGeoJSON(const QJsonDocument &doc)
         region["status"] = status;
 
         m_regions.append(region);
+        m_regionIndex.insert(hcKey, m_regions.size() - 1);
     }
 
     qDebug() << "Всего загружено регионов:" << m_regions.size();
@@ -241,38 +243,89 @@ void MapData::setSelectedRegion(const QString &regionId)
 
 QVariantMap MapData::getRegionById(const QString &regionId) const
 {
-    for (const QVariant &var : m_regions)
+    const int index = m_regionIndex.value(regionId, -1);
+    if (index < 0)
+        return QVariantMap(); // Возвращаем пустой map если не найден
+
+    return m_regions[index].toMap();
+}
+
+void MapData::updateRegionStatus(const QString &regionId, const QString &status)
+{
+    if (!m_regionIndex.contains(regionId))
     {
-        QVariantMap region = var.toMap();
-        if (region["id"].toString() == regionId)
-        {
-            return region;
-        }
+        qWarning() << "Регион с ID" << regionId << "не найден";
+        return;
+    }
+
+    StatusBatch batch;
+    batch.insert(regionId, status);
+
+    // Одиночное изменение дополнительно сообщается через regionStatusChanged
+    if (applyStatusBatch(batch) > 0)
+    {
+        emit regionStatusChanged(regionId, status);
+        qDebug() << "Статус региона" << regionId << "изменен на:" << status;
     }
-    return QVariantMap(); // Возвращаем пустой map если не найден
 }
 
-void MapData::updateRegionStatus(const QString &regionId, const QString &status)
+int MapData::applyStatusBatch(const StatusBatch &batch)
 {
-    for (int i = 0; i < m_regions.size(); ++i)
+    // Кеш геометрии совпадает с m_regions по индексам, если он актуален
+    const bool geometryInSync = m_regionGeometry.size() == m_regions.size();
+
+    QStringList changedIds;
+    for (StatusBatch::const_iterator it = batch.constBegin(); it != batch.constEnd(); ++it)
     {
-        QVariantMap region = m_regions[i].toMap();
-        if (region["id"].toString() == regionId)
-        {
-            QString oldStatus = region["status"].toString();
-            if (oldStatus != status)
-            {
-                region["status"] = status;
-                m_regions[i] = region;
+        const int index = m_regionIndex.value(it.key(), -1);
+        if (index < 0)
+            continue;
 
-                emit regionStatusChanged(regionId, status);
-                emit regionsChanged(); // Для перерисовки карты
-                qDebug() << "Статус региона" << regionId << "изменен на:" << status;
-            }
-            return;
+        QVariantMap region = m_regions[index].toMap();
+        if (region["status"].toString() == it.value())
+            continue;
+
+        region["status"] = it.value();
+        m_regions[index] = region;
+
+        if (geometryInSync && m_regionGeometry[index].id == it.key())
+        {
+            m_regionGeometry[index].status = it.value();
         }
+
+        changedIds.append(it.key());
     }
-    qWarning() << "Регион с ID" << regionId << "не найден";
+
+    if (changedIds.isEmpty())
+        return 0;
+
+    // Один сигнал на весь пакет: перерисовка без повторной подготовки геометрии
+    emit regionStatusesChanged(changedIds);
+
+    return changedIds.size();
+}
+
+QString MapData::regionStatus(const QString &regionId) const
+{
+    const int index = m_regionIndex.value(regionId, -1);
+    if (index < 0)
+        return QString();
+
+    return m_regions[index].toMap()["status"].toString();
+}
+
+StatusBatch MapData::statusSnapshot() const
+{
+    StatusBatch snapshot;
+    snapshot.reserve(m_regions.size());
+
+    for (const QVariant &var : m_regions)
+    {
+        QVariantMap region = var.toMap();
+        snapshot.insert(region["id"].toString(), region["status"].toString());
+    }
+
+    return snapshot;
 }
 
 void MapData::clearSelection()
@@ -347,6 +400,8 @@ void MapData::prepareRegionGeometry()
     }
 
     qDebug() << "Геометрия подготовлена для" << m_regionGeometry.size() << "регионов";
+
+    emit geometryPrepared();
 }
 
 QVariantMap MapData::getRegionAtPoint(qreal x, qreal y, qreal scale, qreal offsetX, qreal offsetY) const
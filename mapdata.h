@@ -11,7 +11,10 @@
 #include <QPointF>
 #include <QRectF>
 #include <QVector>
+#include <QHash>
 
+// Пакет обновлений статусов: ID региона -> новый статус
+typedef QHash<QString, QString> StatusBatch;
 
 class MapData : public QObject
 {
@@ -33,6 +36,11 @@ public:
     Q_INVOKABLE void updateRegionStatus(const QString &regionId, const QString &status);
     Q_INVOKABLE void clearSelection();
 
+    // Пакетное применение статусов: меняются только отличающиеся регионы,
+    // о них сообщает один сигнал regionStatusesChanged (без regionStatusChanged)
+    int applyStatusBatch(const StatusBatch &batch);
+    StatusBatch statusSnapshot() const;
+
     // Внутренний метод для вызова из QML
     Q_INVOKABLE void notifyRegionClicked(const QString &regionId, const QString &regionName);
 
@@ -40,15 +48,6 @@ public:
     Q_INVOKABLE QVariantMap getRegionAtPoint(qreal x, qreal y, qreal scale, qreal offsetX, qreal offsetY) const;
     Q_INVOKABLE void prepareRegionGeometry();
 
-signals:
-    void regionsChanged();
-    void regionStatusChanged(const QString &regionId, const QString &status);
-    void selectedRegionChanged(const QString &regionId);
-
-    // Новые сигналы для обработки событий
-    void regionClicked(const QString &regionId, const QString &regionName);
-
-private:
     struct RegionGeometry {
         QString id;
         QString name;
@@ -58,6 +57,21 @@ private:
         QVector<QVector<QPointF>> polygons; // Список полигонов (каждый полигон = список точек)
     };
 
+    // Подготовленная геометрия (для рендерера), актуальна после geometryPrepared
+    const QVector<RegionGeometry> &regionGeometry() const { return m_regionGeometry; }
+    QString regionStatus(const QString &regionId) const;
+
+signals:
+    void regionsChanged();
+    void regionStatusChanged(const QString &regionId, const QString &status);
+    void regionStatusesChanged(const QStringList &regionIds);
+    void selectedRegionChanged(const QString &regionId);
+    void geometryPrepared();
+
+    // Новые сигналы для обработки событий
+    void regionClicked(const QString &regionId, const QString &regionName);
+
+private:
     void parseGeoJSON(const QJsonDocument &doc);
     QVariantList coordinatesToPath(const QJsonArray &coordinates,
                                    double minX, double maxX,
@@ -73,7 +87,10 @@ private:
     QVariantList m_regions;
     QString m_selectedRegion;
     QVector<RegionGeometry> m_regionGeometry; // Кеш геометрии для быстрого поиска
+    QHash<QString, int> m_regionIndex;         // ID региона -> индекс в m_regions
 };
 
+Q_DECLARE_METATYPE(StatusBatch)
+
 #endif // MAPDATA_H
 
@@ -0,0 +1,856 @@
+#include "maprenderer.h"
+#include <QDebug>
+#include <QOpenGLShaderProgram>
+#include <QSGFlatColorMaterial>
+#include <QSGGeometryNode>
+#include <QSGMaterial>
+#include <QSGTransformNode>
+#include <QtMath>
+#include <algorithm>
+
+namespace {
+
+// Базовый размер карты, в котором MapData строит координаты путей
+const qreal baseMapWidth = 1000.0;
+const qreal baseMapHeight = 700.0;
+
+// Через сколько миллисекунд отсчет времени переходов начинается заново,
+// чтобы время в float (атрибуты вершин и uniform) не теряло точность
+const qint64 clockRebaseInterval = 60000;
+
+// ============================================================================
+// Материал с анимацией цвета на GPU
+// ============================================================================
+
+// Вершина заливки: позиция + параметры перехода цвета региона
+struct RegionVertex {
+    float x, y;
+    float fromR, fromG, fromB, fromA;
+    float toR, toG, toB, toA;
+    float startTime, duration, fromPulse, toPulse;
+};
+
+const QSGGeometry::AttributeSet &regionAttributes()
+{
+    static QSGGeometry::Attribute attributes[] = {
+        QSGGeometry::Attribute::createWithAttributeType(0, 2, QSGGeometry::FloatType, QSGGeometry::PositionAttribute),
+        QSGGeometry::Attribute::createWithAttributeType(1, 4, QSGGeometry::FloatType, QSGGeometry::ColorAttribute),
+        QSGGeometry::Attribute::createWithAttributeType(2, 4, QSGGeometry::FloatType, QSGGeometry::ColorAttribute),
+        QSGGeometry::Attribute::createWithAttributeType(3, 4, QSGGeometry::FloatType, QSGGeometry::UnknownAttribute)
+    };
+    static QSGGeometry::AttributeSet set = { 4, sizeof(RegionVertex), attributes };
+    return set;
+}
+
+// Общий материал всех регионов: один экземпляр, меняется только время кадра
+class RegionColorMaterial : public QSGMaterial
+{
+public:
+    RegionColorMaterial()
+        : time(0), pulsePhase(0), pulseAmplitude(0), pulseColor(Qt::white)
+    {
+        // Blending включается в MapRenderer::updatePaintNode только для
+        // полупрозрачной палитры, иначе заливки идут в непрозрачный проход
+    }
+
+    QSGMaterialType *type() const override
+    {
+        static QSGMaterialType type;
+        return &type;
+    }
+
+    QSGMaterialShader *createShader() const override;
+
+    float time;       // Секунды с последней перебазировки часов
+    float pulsePhase; // Фаза пульсации 0..1, считается на CPU
+    float pulseAmplitude;
+    QColor pulseColor;
+};
+
+// Интерполяция цвета выполняется в вершинном шейдере: значение одно
+// на регион, поэтому фрагментный шейдер только применяет прозрачность
+class RegionColorShader : public QSGMaterialShader
+{
+public:
+    const char *vertexShader() const override
+    {
+        return
+            "attribute highp vec4 vertex;\n"
+            "attribute highp vec4 fromColor;\n"
+            "attribute highp vec4 toColor;\n"
+            "attribute highp vec4 timing;\n"
+            "uniform highp mat4 qt_Matrix;\n"
+            "uniform highp float time;\n"
+            "uniform highp float pulsePhase;\n"
+            "uniform highp float pulseAmplitude;\n"
+            "uniform lowp vec4 pulseColor;\n"
+            "varying lowp vec4 color;\n"
+            "void main() {\n"
+            "    highp float progress = timing.y > 0.0 ? clamp((time - timing.x) / timing.y, 0.0, 1.0) : 1.0;\n"
+            "    progress = progress * progress * (3.0 - 2.0 * progress);\n"
+            "    lowp vec4 base = mix(fromColor, toColor, progress);\n"
+            "    highp float pulse = mix(timing.z, timing.w, progress);\n"
+            "    highp float wave = 0.5 - 0.5 * cos(6.2831853 * pulsePhase);\n"
+            "    color = mix(base, pulseColor, pulseAmplitude * pulse * wave);\n"
+            "    gl_Position = qt_Matrix * vertex;\n"
+            "}\n";
+    }
+
+    const char *fragmentShader() const override
+    {
+        return
+            "varying lowp vec4 color;\n"
+            "uniform lowp float qt_Opacity;\n"
+            "void main() {\n"
+            "    gl_FragColor = vec4(color.rgb * color.a, color.a) * qt_Opacity;\n"
+            "}\n";
+    }
+
+    char const *const *attributeNames() const override
+    {
+        static const char *names[] = { "vertex", "fromColor", "toColor", "timing", nullptr };
+        return names;
+    }
+
+    void updateState(const RenderState &state, QSGMaterial *newMaterial, QSGMaterial *oldMaterial) override
+    {
+        Q_UNUSED(oldMaterial);
+
+        if (state.isMatrixDirty())
+            program()->setUniformValue(m_matrixId, state.combinedMatrix());
+        if (state.isOpacityDirty())
+            program()->setUniformValue(m_opacityId, state.opacity());
+
+        // Время меняется каждый кадр, поэтому передаем его без проверок
+        RegionColorMaterial *material = static_cast<RegionColorMaterial *>(newMaterial);
+        program()->setUniformValue(m_timeId, material->time);
+        program()->setUniformValue(m_pulsePhaseId, material->pulsePhase);
+        program()->setUniformValue(m_pulseAmplitudeId, material->pulseAmplitude);
+        program()->setUniformValue(m_pulseColorId, material->pulseColor);
+    }
+
+protected:
+    void initialize() override
+    {
+        m_matrixId = program()->uniformLocation("qt_Matrix");
+        m_opacityId = program()->uniformLocation("qt_Opacity");
+        m_timeId = program()->uniformLocation("time");
+        m_pulsePhaseId = program()->uniformLocation("pulsePhase");
+        m_pulseAmplitudeId = program()->uniformLocation("pulseAmplitude");
+        m_pulseColorId = program()->uniformLocation("pulseColor");
+    }
+
+private:
+    int m_matrixId;
+    int m_opacityId;
+    int m_timeId;
+    int m_pulsePhaseId;
+    int m_pulseAmplitudeId;
+    int m_pulseColorId;
+};
+
+QSGMaterialShader *RegionColorMaterial::createShader() const
+{
+    return new RegionColorShader;
+}
+
+// ============================================================================
+// Узлы scene graph
+// ============================================================================
+
+// Корневой узел карты: трансформация + заливки регионов + общая обводка
+class MapRootNode : public QSGTransformNode
+{
+public:
+    MapRootNode() : material(new RegionColorMaterial), strokeNode(nullptr) {}
+    ~MapRootNode() override { delete material; }
+
+    RegionColorMaterial *material;
+    QVector<QSGGeometryNode *> fillNodes; // Индексы совпадают с MapRenderer::m_visuals
+    QSGGeometryNode *strokeNode;
+};
+
+void writeColorAttributes(QSGGeometry *geometry, const MapRenderer::RegionVisual &visual)
+{
+    RegionVertex *vertices = static_cast<RegionVertex *>(geometry->vertexData());
+    for (int i = 0; i < geometry->vertexCount(); ++i) {
+        RegionVertex &v = vertices[i];
+        v.fromR = visual.fromColor.redF();
+        v.fromG = visual.fromColor.greenF();
+        v.fromB = visual.fromColor.blueF();
+        v.fromA = visual.fromColor.alphaF();
+        v.toR = visual.toColor.redF();
+        v.toG = visual.toColor.greenF();
+        v.toB = visual.toColor.blueF();
+        v.toA = visual.toColor.alphaF();
+        v.startTime = visual.startTime;
+        v.duration = visual.duration;
+        v.fromPulse = visual.fromPulse;
+        v.toPulse = visual.toPulse;
+    }
+}
+
+QSGGeometryNode *createFillNode(const MapRenderer::RegionVisual &visual, RegionColorMaterial *material)
+{
+    QSGGeometry *geometry = new QSGGeometry(regionAttributes(), visual.triangles.size());
+    geometry->setDrawingMode(QSGGeometry::DrawTriangles);
+
+    RegionVertex *vertices = static_cast<RegionVertex *>(geometry->vertexData());
+    for (int i = 0; i < visual.triangles.size(); ++i) {
+        vertices[i].x = visual.triangles[i].x();
+        vertices[i].y = visual.triangles[i].y();
+    }
+    writeColorAttributes(geometry, visual);
+
+    QSGGeometryNode *node = new QSGGeometryNode;
+    node->setGeometry(geometry);
+    node->setFlag(QSGNode::OwnsGeometry);
+    node->setMaterial(material); // Материал общий, им владеет MapRootNode
+    return node;
+}
+
+QSGGeometry *createStrokeGeometry(const QVector<QPointF> &triangles)
+{
+    QSGGeometry *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), triangles.size());
+    geometry->setDrawingMode(QSGGeometry::DrawTriangles);
+
+    QSGGeometry::Point2D *points = geometry->vertexDataAsPoint2D();
+    for (int i = 0; i < triangles.size(); ++i) {
+        points[i].set(triangles[i].x(), triangles[i].y());
+    }
+    return geometry;
+}
+
+// ============================================================================
+// Подготовка геометрии
+// ============================================================================
+
+// Удвоенная ориентированная площадь треугольника (> 0 для обхода против часовой)
+qreal cross(const QPointF &a, const QPointF &b, const QPointF &c)
+{
+    return (b.x() - a.x()) * (c.y() - a.y()) - (b.y() - a.y()) * (c.x() - a.x());
+}
+
+bool isPointInTriangle(const QPointF &p, const QPointF &a, const QPointF &b, const QPointF &c)
+{
+    return cross(a, b, p) >= 0 && cross(b, c, p) >= 0 && cross(c, a, p) >= 0;
+}
+
+// Убираем замыкающую и повторяющиеся точки контура
+QVector<QPointF> cleanRing(const QVector<QPointF> &polygon)
+{
+    QVector<QPointF> ring;
+    ring.reserve(polygon.size());
+
+    for (const QPointF &point : polygon) {
+        if (ring.isEmpty() || ring.last() != point) {
+            ring.append(point);
+        }
+    }
+
+    while (ring.size() > 1 && ring.first() == ring.last()) {
+        ring.removeLast();
+    }
+
+    return ring;
+}
+
+// Триангуляция контура методом отсечения ушей. Каждый контур заливается
+// отдельно, как и в прежней отрисовке через Canvas
+void triangulateRing(QVector<QPointF> ring, QVector<QPointF> &triangles)
+{
+    if (ring.size() < 3) {
+        return;
+    }
+
+    qreal area = 0;
+    for (int i = 0, j = ring.size() - 1; i < ring.size(); j = i++) {
+        area += ring[j].x() * ring[i].y() - ring[i].x() * ring[j].y();
+    }
+    if (area < 0) {
+        std::reverse(ring.begin(), ring.end());
+    }
+
+    QVector<int> indices(ring.size());
+    for (int i = 0; i < ring.size(); ++i) {
+        indices[i] = i;
+    }
+
+    int current = 0;
+    int attempts = 0;
+
+    while (indices.size() > 3) {
+        const int count = indices.size();
+        current %= count;
+
+        const QPointF &a = ring[indices[(current + count - 1) % count]];
+        const QPointF &b = ring[indices[current]];
+        const QPointF &c = ring[indices[(current + 1) % count]];
+        const qreal turn = cross(a, b, c);
+
+        if (qFuzzyIsNull(turn)) {
+            // Вырожденная вершина на прямой - просто убираем
+            indices.remove(current);
+            attempts = 0;
+            continue;
+        }
+
+        bool isEar = turn > 0;
+        if (isEar) {
+            for (int k = 0; k < count && isEar; ++k) {
+                const QPointF &p = ring[indices[k]];
+                if (p == a || p == b || p == c)
+                    continue;
+                if (isPointInTriangle(p, a, b, c))
+                    isEar = false;
+            }
+        }
+
+        if (isEar) {
+            triangles << a << b << c;
+            indices.remove(current);
+            attempts = 0;
+        } else if (++attempts > count) {
+            // Самопересекающийся контур: оставшееся заливаем веером
+            for (int k = 1; k + 1 < count; ++k) {
+                triangles << ring[indices[0]] << ring[indices[k]] << ring[indices[k + 1]];
+            }
+            return;
+        } else {
+            ++current;
+        }
+    }
+
+    triangles << ring[indices[0]] << ring[indices[1]] << ring[indices[2]];
+}
+
+// Обводка контура: прямоугольник вдоль каждого отрезка и соединение
+// с внешней стороны каждой вершины (miter, для острых углов - bevel)
+void strokeRing(const QVector<QPointF> &ring, qreal width, QVector<QPointF> &triangles)
+{
+    const qreal halfWidth = width / 2;
+    const qreal miterLimit = 2.0; // Максимальная длина острия в долях halfWidth
+    const int count = ring.size();
+
+    // Нормали отрезков ring[i] -> ring[i + 1] длиной halfWidth
+    QVector<QPointF> normals(count);
+
+    for (int i = 0; i < count; ++i) {
+        const QPointF &a = ring[i];
+        const QPointF &b = ring[(i + 1) % count];
+
+        const qreal dx = b.x() - a.x();
+        const qreal dy = b.y() - a.y();
+        const qreal length = qSqrt(dx * dx + dy * dy);
+        if (qFuzzyIsNull(length))
+            continue;
+
+        const QPointF normal(-dy / length * halfWidth, dx / length * halfWidth);
+        normals[i] = normal;
+        triangles << a + normal << a - normal << b + normal
+                  << b + normal << a - normal << b - normal;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        const QPointF &p = ring[i];
+        const QPointF &n0 = normals[(i + count - 1) % count];
+        const QPointF &n1 = normals[i];
+
+        // Знак поворота определяет внешнюю сторону угла
+        const qreal turn = n0.x() * n1.y() - n0.y() * n1.x();
+        if (qFuzzyIsNull(turn))
+            continue;
+
+        const qreal side = turn > 0 ? -1.0 : 1.0;
+        const QPointF outer0 = p + n0 * side;
+        const QPointF outer1 = p + n1 * side;
+
+        // Bevel закрывает вырез между прямоугольниками соседних отрезков
+        triangles << p << outer0 << outer1;
+
+        // Острие miter, если угол не слишком острый
+        const QPointF bisector = n0 + n1;
+        const qreal bisectorLength = qSqrt(bisector.x() * bisector.x() + bisector.y() * bisector.y());
+        if (qFuzzyIsNull(bisectorLength))
+            continue;
+
+        const qreal cosHalf = (bisector.x() * n0.x() + bisector.y() * n0.y()) / (bisectorLength * halfWidth);
+        if (cosHalf * miterLimit < 1.0)
+            continue;
+
+        const QPointF tip = p + bisector * (side * halfWidth / (cosHalf * bisectorLength));
+        triangles << outer0 << tip << outer1;
+    }
+}
+
+QColor mixColor(const QColor &from, const QColor &to, qreal t)
+{
+    return QColor::fromRgbF(from.redF() + (to.redF() - from.redF()) * t,
+                            from.greenF() + (to.greenF() - from.greenF()) * t,
+                            from.blueF() + (to.blueF() - from.blueF()) * t,
+                            from.alphaF() + (to.alphaF() - from.alphaF()) * t);
+}
+
+}
+
+// ============================================================================
+// MapRenderer
+// ============================================================================
+
+MapRenderer::MapRenderer(QQuickItem *parent)
+    : QQuickItem(parent),
+      m_defaultColor("#5CA8FF"),
+      m_warningColor("#FFB84D"),
+      m_dangerColor("#FF5C5C"),
+      m_defaultActiveColor("#1E7FFF"),
+      m_warningActiveColor("#FF9500"),
+      m_dangerActiveColor("#E53935"),
+      m_strokeColor("#ffffff"),
+      m_strokeWidth(1),
+      m_transitionDuration(250),
+      m_pulsePeriod(1200),
+      m_pulseAmplitude(0.35),
+      m_pulseColor("#ffffff"),
+      m_scale(1.0),
+      m_selectedIndex(-1),
+      m_pulsingCount(0),
+      m_animationEnd(0),
+      m_geometryDirty(true),
+      m_strokeDirty(false),
+      m_transformDirty(true)
+{
+    setFlag(ItemHasContents, true);
+    m_clock.start();
+    m_pulseClock.start();
+}
+
+void MapRenderer::setSource(MapData *source)
+{
+    if (m_source == source)
+        return;
+
+    if (m_source) {
+        disconnect(m_source, nullptr, this, nullptr);
+    }
+
+    m_source = source;
+
+    if (m_source) {
+        connect(m_source, &MapData::geometryPrepared, this, &MapRenderer::rebuildGeometry);
+        connect(m_source, &MapData::regionStatusesChanged, this, &MapRenderer::onRegionStatusesChanged);
+        connect(m_source, &MapData::selectedRegionChanged, this, &MapRenderer::onSelectedRegionChanged);
+    }
+
+    emit sourceChanged();
+    rebuildGeometry();
+}
+
+void MapRenderer::setColor(QColor &field, const QColor &color)
+{
+    if (field == color)
+        return;
+
+    field = color;
+    emit colorsChanged();
+    retargetAll();
+}
+
+void MapRenderer::setDefaultColor(const QColor &color) { setColor(m_defaultColor, color); }
+void MapRenderer::setWarningColor(const QColor &color) { setColor(m_warningColor, color); }
+void MapRenderer::setDangerColor(const QColor &color) { setColor(m_dangerColor, color); }
+void MapRenderer::setDefaultActiveColor(const QColor &color) { setColor(m_defaultActiveColor, color); }
+void MapRenderer::setWarningActiveColor(const QColor &color) { setColor(m_warningActiveColor, color); }
+void MapRenderer::setDangerActiveColor(const QColor &color) { setColor(m_dangerActiveColor, color); }
+
+void MapRenderer::setStrokeColor(const QColor &color)
+{
+    if (m_strokeColor == color)
+        return;
+
+    m_strokeColor = color;
+    emit strokeChanged();
+    update();
+}
+
+void MapRenderer::setStrokeWidth(qreal width)
+{
+    if (m_strokeWidth == width)
+        return;
+
+    m_strokeWidth = width;
+    buildStroke();
+    emit strokeChanged();
+    update();
+}
+
+void MapRenderer::setTransitionDuration(int msec)
+{
+    if (m_transitionDuration == msec)
+        return;
+
+    m_transitionDuration = qMax(0, msec);
+    emit animationChanged();
+}
+
+void MapRenderer::setPulsePeriod(int msec)
+{
+    if (m_pulsePeriod == msec)
+        return;
+
+    m_pulsePeriod = qMax(1, msec);
+    emit animationChanged();
+    update();
+}
+
+void MapRenderer::setPulseAmplitude(qreal amplitude)
+{
+    amplitude = qBound(0.0, amplitude, 1.0);
+    if (qFuzzyCompare(m_pulseAmplitude, amplitude))
+        return;
+
+    m_pulseAmplitude = amplitude;
+    emit animationChanged();
+    update();
+}
+
+void MapRenderer::setPulseColor(const QColor &color)
+{
+    if (m_pulseColor == color)
+        return;
+
+    m_pulseColor = color;
+    emit animationChanged();
+    update();
+}
+
+float MapRenderer::currentTime() const
+{
+    return m_clock.elapsed() / 1000.0f;
+}
+
+// Сдвигает начало отсчета m_clock к текущему моменту. Завершенные переходы
+// приводятся к покою (startTime = 0, duration = 0), у незавершенных
+// startTime смещается, поэтому значения времени всегда остаются малыми
+void MapRenderer::rebaseClock()
+{
+    if (m_clock.elapsed() < clockRebaseInterval)
+        return;
+
+    const float shift = m_clock.restart() / 1000.0f;
+
+    for (int i = 0; i < m_visuals.size(); ++i) {
+        RegionVisual &visual = m_visuals[i];
+        if (visual.duration <= 0 && visual.startTime == 0)
+            continue;
+
+        if (visual.startTime + visual.duration <= shift) {
+            visual.fromColor = visual.toColor;
+            visual.fromPulse = visual.toPulse;
+            visual.startTime = 0;
+            visual.duration = 0;
+        } else {
+            visual.startTime -= shift;
+        }
+        m_dirtyRegions.insert(i);
+    }
+
+    m_animationEnd = qMax(0.0f, m_animationEnd - shift);
+}
+
+QColor MapRenderer::targetColor(const QString &status, bool selected) const
+{
+    if (status == "warning") {
+        return selected ? m_warningActiveColor : m_warningColor;
+    } else if (status == "danger") {
+        return selected ? m_dangerActiveColor : m_dangerColor;
+    }
+    return selected ? m_defaultActiveColor : m_defaultColor;
+}
+
+// Запускает переход региона к цвету его текущего статуса и выбора.
+// Начальный цвет берется с учетом незавершенного перехода, чтобы не было скачка
+void MapRenderer::retarget(int index, bool animate)
+{
+    RegionVisual &visual = m_visuals[index];
+
+    const QColor target = targetColor(visual.status, visual.selected);
+    const float targetPulse = visual.status == "danger" ? 1.0f : 0.0f;
+
+    if (visual.toColor == target && visual.toPulse == targetPulse)
+        return;
+
+    rebaseClock();
+    const float now = currentTime();
+
+    // Та же функция плавности, что и в шейдере
+    float progress = 1.0f;
+    if (visual.duration > 0) {
+        progress = qBound(0.0f, (now - visual.startTime) / visual.duration, 1.0f);
+        progress = progress * progress * (3.0f - 2.0f * progress);
+    }
+
+    visual.fromColor = animate ? mixColor(visual.fromColor, visual.toColor, progress) : target;
+    visual.fromPulse = animate ? visual.fromPulse + (visual.toPulse - visual.fromPulse) * progress : targetPulse;
+
+    if (visual.toPulse > 0)
+        --m_pulsingCount;
+    if (targetPulse > 0)
+        ++m_pulsingCount;
+
+    visual.toColor = target;
+    visual.toPulse = targetPulse;
+    visual.startTime = now;
+    visual.duration = animate ? m_transitionDuration / 1000.0f : 0.0f;
+    m_animationEnd = qMax(m_animationEnd, now + visual.duration);
+
+    m_dirtyRegions.insert(index);
+    update();
+}
+
+// Смена палитры применяется сразу, без перехода
+void MapRenderer::retargetAll()
+{
+    for (int i = 0; i < m_visuals.size(); ++i) {
+        retarget(i, false);
+    }
+}
+
+bool MapRenderer::needsBlending() const
+{
+    const QColor palette[] = {
+        m_defaultColor, m_warningColor, m_dangerColor,
+        m_defaultActiveColor, m_warningActiveColor, m_dangerActiveColor
+    };
+
+    for (const QColor &color : palette) {
+        if (color.alpha() < 255)
+            return true;
+    }
+
+    return m_pulseAmplitude > 0 && m_pulseColor.alpha() < 255;
+}
+
+void MapRenderer::onRegionStatusesChanged(const QStringList &regionIds)
+{
+    if (!m_source)
+        return;
+
+    for (const QString &regionId : regionIds) {
+        const int index = m_indexById.value(regionId, -1);
+        if (index < 0)
+            continue;
+
+        m_visuals[index].status = m_source->regionStatus(regionId);
+        retarget(index, true);
+    }
+}
+
+void MapRenderer::onSelectedRegionChanged(const QString &regionId)
+{
+    if (m_selectedIndex >= 0) {
+        m_visuals[m_selectedIndex].selected = false;
+        retarget(m_selectedIndex, true);
+    }
+
+    m_selectedIndex = m_indexById.value(regionId, -1);
+
+    if (m_selectedIndex >= 0) {
+        m_visuals[m_selectedIndex].selected = true;
+        retarget(m_selectedIndex, true);
+    }
+}
+
+// Триангуляция выполняется один раз после подготовки геометрии в MapData.
+// Смена статусов и выбора сюда не приходит
+void MapRenderer::rebuildGeometry()
+{
+    const int oldCount = m_visuals.size();
+
+    m_visuals.clear();
+    m_indexById.clear();
+    m_rings.clear();
+    m_selectedIndex = -1;
+    m_pulsingCount = 0;
+
+    if (m_source) {
+        const QVector<MapData::RegionGeometry> &geometry = m_source->regionGeometry();
+        const QString selectedId = m_source->selectedRegion();
+
+        m_visuals.reserve(geometry.size());
+
+        for (const MapData::RegionGeometry &region : geometry) {
+            RegionVisual visual;
+            visual.id = region.id;
+            visual.status = region.status;
+            visual.selected = region.id == selectedId;
+
+            for (const QVector<QPointF> &polygon : region.polygons) {
+                QVector<QPointF> ring = cleanRing(polygon);
+                if (ring.size() < 3)
+                    continue;
+
+                triangulateRing(ring, visual.triangles);
+                m_rings.append(ring);
+            }
+
+            // Начальное состояние без анимации
+            visual.toColor = targetColor(visual.status, visual.selected);
+            visual.fromColor = visual.toColor;
+            visual.toPulse = visual.status == "danger" ? 1.0f : 0.0f;
+            visual.fromPulse = visual.toPulse;
+            visual.startTime = 0;
+            visual.duration = 0;
+
+            if (visual.toPulse > 0)
+                ++m_pulsingCount;
+            if (visual.selected)
+                m_selectedIndex = m_visuals.size();
+
+            m_indexById.insert(visual.id, m_visuals.size());
+            m_visuals.append(visual);
+        }
+
+        qDebug() << "MapRenderer: триангулировано регионов:" << m_visuals.size();
+    }
+
+    buildStroke();
+
+    m_geometryDirty = true;
+    m_dirtyRegions.clear();
+
+    if (oldCount != m_visuals.size())
+        emit regionCountChanged();
+
+    update();
+}
+
+void MapRenderer::buildStroke()
+{
+    m_strokeTriangles.clear();
+
+    if (m_strokeWidth > 0) {
+        for (const QVector<QPointF> &ring : m_rings) {
+            strokeRing(ring, m_strokeWidth, m_strokeTriangles);
+        }
+    }
+
+    m_strokeDirty = true;
+}
+
+void MapRenderer::geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChanged(newGeometry, oldGeometry);
+
+    if (newGeometry.size() != oldGeometry.size()) {
+        updateTransform();
+    }
+}
+
+// Масштаб и смещение для центрирования карты с сохранением пропорций
+void MapRenderer::updateTransform()
+{
+    m_scale = qMin(width() / baseMapWidth, height() / baseMapHeight);
+    m_offset = QPointF((width() - baseMapWidth * m_scale) / 2,
+                       (height() - baseMapHeight * m_scale) / 2);
+
+    m_transformDirty = true;
+    emit transformChanged();
+    update();
+}
+
+QSGNode *MapRenderer::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+{
+    Q_UNUSED(data);
+
+    MapRootNode *root = static_cast<MapRootNode *>(oldNode);
+    if (!root) {
+        root = new MapRootNode;
+        m_geometryDirty = true;
+        m_transformDirty = true;
+    }
+
+    rebaseClock();
+
+    if (m_geometryDirty) {
+        // Узел при удалении сам отсоединяется от родителя
+        while (QSGNode *child = root->firstChild()) {
+            delete child;
+        }
+        root->fillNodes.clear();
+        root->fillNodes.reserve(m_visuals.size());
+
+        for (const RegionVisual &visual : m_visuals) {
+            QSGGeometryNode *node = createFillNode(visual, root->material);
+            root->fillNodes.append(node);
+            root->appendChildNode(node);
+        }
+
+        QSGFlatColorMaterial *strokeMaterial = new QSGFlatColorMaterial;
+        strokeMaterial->setColor(m_strokeColor);
+
+        root->strokeNode = new QSGGeometryNode;
+        root->strokeNode->setGeometry(createStrokeGeometry(m_strokeTriangles));
+        root->strokeNode->setMaterial(strokeMaterial);
+        root->strokeNode->setFlags(QSGNode::OwnsGeometry | QSGNode::OwnsMaterial);
+        root->appendChildNode(root->strokeNode);
+
+        m_geometryDirty = false;
+        m_strokeDirty = false;
+        m_dirtyRegions.clear();
+    }
+
+    // Смена статуса: перезаписываем только цветовые атрибуты изменившихся регионов
+    for (int index : m_dirtyRegions) {
+        QSGGeometryNode *node = root->fillNodes.value(index);
+        if (!node)
+            continue;
+
+        writeColorAttributes(node->geometry(), m_visuals[index]);
+        node->markDirty(QSGNode::DirtyGeometry);
+    }
+    m_dirtyRegions.clear();
+
+    if (m_strokeDirty) {
+        root->strokeNode->setGeometry(createStrokeGeometry(m_strokeTriangles));
+        root->strokeNode->markDirty(QSGNode::DirtyGeometry);
+        m_strokeDirty = false;
+    }
+
+    QSGFlatColorMaterial *strokeMaterial = static_cast<QSGFlatColorMaterial *>(root->strokeNode->material());
+    if (strokeMaterial->color() != m_strokeColor) {
+        strokeMaterial->setColor(m_strokeColor);
+        root->strokeNode->markDirty(QSGNode::DirtyMaterial);
+    }
+
+    if (m_transformDirty) {
+        QMatrix4x4 matrix;
+        matrix.translate(m_offset.x(), m_offset.y());
+        matrix.scale(m_scale, m_scale);
+        root->setMatrix(matrix);
+        m_transformDirty = false;
+    }
+
+    // Смешивание нужно только при полупрозрачных цветах
+    const bool blending = needsBlending();
+    if (root->material->flags().testFlag(QSGMaterial::Blending) != blending) {
+        root->material->setFlag(QSGMaterial::Blending, blending);
+        for (QSGGeometryNode *node : root->fillNodes) {
+            node->markDirty(QSGNode::DirtyMaterial);
+        }
+    }
+
+    // Параметры анимации для шейдера
+    const float now = currentTime();
+    root->material->time = now;
+    root->material->pulsePhase = (m_pulseClock.elapsed() % m_pulsePeriod) / float(m_pulsePeriod);
+    root->material->pulseAmplitude = m_pulseAmplitude;
+    root->material->pulseColor = m_pulseColor;
+
+    // Следующий кадр нужен, только пока идет переход или пульсация видима
+    const bool pulsing = m_pulsingCount > 0 && m_pulseAmplitude > 0;
+    if (pulsing || now < m_animationEnd) {
+        QMetaObject::invokeMethod(this, "update", Qt::QueuedConnection);
+    }
+
+    return root;
+}
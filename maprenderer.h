@@ -0,0 +1,164 @@
+#ifndef MAPRENDERER_H
+#define MAPRENDERER_H
+
+#include <QQuickItem>
+#include <QPointer>
+#include <QColor>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QPointF>
+#include "mapdata.h"
+
+// Отрисовка карты через scene graph. Геометрия регионов триангулируется
+// один раз, а смена статуса или выбора только меняет цветовые атрибуты
+// вершин региона: переход между цветами и пульсация регионов "danger"
+// вычисляются в шейдере по текущему времени кадра.
+class MapRenderer : public QQuickItem
+{
+    Q_OBJECT
+    Q_PROPERTY(MapData *source READ source WRITE setSource NOTIFY sourceChanged)
+
+    // Цвета регионов
+    Q_PROPERTY(QColor defaultColor READ defaultColor WRITE setDefaultColor NOTIFY colorsChanged)
+    Q_PROPERTY(QColor warningColor READ warningColor WRITE setWarningColor NOTIFY colorsChanged)
+    Q_PROPERTY(QColor dangerColor READ dangerColor WRITE setDangerColor NOTIFY colorsChanged)
+    Q_PROPERTY(QColor defaultActiveColor READ defaultActiveColor WRITE setDefaultActiveColor NOTIFY colorsChanged)
+    Q_PROPERTY(QColor warningActiveColor READ warningActiveColor WRITE setWarningActiveColor NOTIFY colorsChanged)
+    Q_PROPERTY(QColor dangerActiveColor READ dangerActiveColor WRITE setDangerActiveColor NOTIFY colorsChanged)
+
+    // Обводка
+    Q_PROPERTY(QColor strokeColor READ strokeColor WRITE setStrokeColor NOTIFY strokeChanged)
+    Q_PROPERTY(qreal strokeWidth READ strokeWidth WRITE setStrokeWidth NOTIFY strokeChanged)
+
+    // Анимация
+    Q_PROPERTY(int transitionDuration READ transitionDuration WRITE setTransitionDuration NOTIFY animationChanged)
+    Q_PROPERTY(int pulsePeriod READ pulsePeriod WRITE setPulsePeriod NOTIFY animationChanged)
+    Q_PROPERTY(qreal pulseAmplitude READ pulseAmplitude WRITE setPulseAmplitude NOTIFY animationChanged)
+    Q_PROPERTY(QColor pulseColor READ pulseColor WRITE setPulseColor NOTIFY animationChanged)
+
+    // Трансформация карты в координаты элемента (для поиска региона по точке)
+    Q_PROPERTY(qreal actualScale READ actualScale NOTIFY transformChanged)
+    Q_PROPERTY(qreal offsetX READ offsetX NOTIFY transformChanged)
+    Q_PROPERTY(qreal offsetY READ offsetY NOTIFY transformChanged)
+    Q_PROPERTY(int regionCount READ regionCount NOTIFY regionCountChanged)
+
+public:
+    explicit MapRenderer(QQuickItem *parent = nullptr);
+
+    MapData *source() const { return m_source; }
+    void setSource(MapData *source);
+
+    QColor defaultColor() const { return m_defaultColor; }
+    void setDefaultColor(const QColor &color);
+    QColor warningColor() const { return m_warningColor; }
+    void setWarningColor(const QColor &color);
+    QColor dangerColor() const { return m_dangerColor; }
+    void setDangerColor(const QColor &color);
+    QColor defaultActiveColor() const { return m_defaultActiveColor; }
+    void setDefaultActiveColor(const QColor &color);
+    QColor warningActiveColor() const { return m_warningActiveColor; }
+    void setWarningActiveColor(const QColor &color);
+    QColor dangerActiveColor() const { return m_dangerActiveColor; }
+    void setDangerActiveColor(const QColor &color);
+
+    QColor strokeColor() const { return m_strokeColor; }
+    void setStrokeColor(const QColor &color);
+    qreal strokeWidth() const { return m_strokeWidth; }
+    void setStrokeWidth(qreal width);
+
+    int transitionDuration() const { return m_transitionDuration; }
+    void setTransitionDuration(int msec);
+    int pulsePeriod() const { return m_pulsePeriod; }
+    void setPulsePeriod(int msec);
+    qreal pulseAmplitude() const { return m_pulseAmplitude; }
+    void setPulseAmplitude(qreal amplitude);
+    QColor pulseColor() const { return m_pulseColor; }
+    void setPulseColor(const QColor &color);
+
+    qreal actualScale() const { return m_scale; }
+    qreal offsetX() const { return m_offset.x(); }
+    qreal offsetY() const { return m_offset.y(); }
+    int regionCount() const { return m_visuals.size(); }
+
+    // Состояние цвета региона: переход from -> to начиная с startTime
+    struct RegionVisual {
+        QString id;
+        QString status;
+        bool selected;
+        QVector<QPointF> triangles; // Вершины заливки, по 3 на треугольник
+        QColor fromColor;
+        QColor toColor;
+        float fromPulse;
+        float toPulse;
+        float startTime;
+        float duration;
+    };
+
+signals:
+    void sourceChanged();
+    void colorsChanged();
+    void strokeChanged();
+    void animationChanged();
+    void transformChanged();
+    void regionCountChanged();
+
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+    void geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry) override;
+
+private slots:
+    void rebuildGeometry();
+    void onRegionStatusesChanged(const QStringList &regionIds);
+    void onSelectedRegionChanged(const QString &regionId);
+
+private:
+    QColor targetColor(const QString &status, bool selected) const;
+    void retarget(int index, bool animate);
+    void retargetAll();
+    bool needsBlending() const;
+    void setColor(QColor &field, const QColor &color);
+    void buildStroke();
+    void updateTransform();
+    float currentTime() const;
+    void rebaseClock();
+
+    QPointer<MapData> m_source;
+
+    QColor m_defaultColor;
+    QColor m_warningColor;
+    QColor m_dangerColor;
+    QColor m_defaultActiveColor;
+    QColor m_warningActiveColor;
+    QColor m_dangerActiveColor;
+    QColor m_strokeColor;
+    qreal m_strokeWidth;
+
+    int m_transitionDuration;
+    int m_pulsePeriod;
+    qreal m_pulseAmplitude;
+    QColor m_pulseColor;
+
+    qreal m_scale;
+    QPointF m_offset;
+
+    QVector<RegionVisual> m_visuals;
+    QHash<QString, int> m_indexById;
+    QVector<QVector<QPointF>> m_rings; // Контуры всех регионов для обводки
+    QVector<QPointF> m_strokeTriangles;
+    int m_selectedIndex;
+    int m_pulsingCount;
+    float m_animationEnd;
+
+    // Что нужно передать в scene graph при следующей синхронизации
+    bool m_geometryDirty;
+    bool m_strokeDirty;
+    bool m_transformDirty;
+    QSet<int> m_dirtyRegions;
+
+    QElapsedTimer m_clock;      // Время переходов, периодически перебазируется
+    QElapsedTimer m_pulseClock; // Только для фазы пульсации
+};
+
+#endif // MAPRENDERER_H
@@ -26,221 +26,49 @@ Item {
     property real strokeWidth: 1
     property real activeStrokeWidth: 2
 
+    // Анимация: длительность перехода цвета и пульсация регионов "danger"
+    property int transitionDuration: 250
+    property int pulsePeriod: 1200
+    property real pulseAmplitude: 0.35
+    property color pulseColor: "#ffffff"
+
     // Сигналы для внешнего использования
     signal regionClicked(string regionId, string regionName)
     signal regionHovered(string regionId, string regionName)
     signal regionExited()
 
-    // Таймер для debounce при изменении размера
-    Timer {
-        id: resizeTimer
-        interval: 150
-        repeat: false
-        onTriggered: {
-            console.log("Перерисовка после изменения размера")
-            mapCanvas.requestPaint()
-        }
-    }
-
-    Canvas {
-        id: mapCanvas
+    MapRenderer {
+        id: mapRenderer
         anchors.fill: parent
 
-        // Оптимизация рендеринга
-        renderStrategy: Canvas.Threaded
-        renderTarget: Canvas.FramebufferObject
-
-        // Внутренние свойства для масштабирования
-        property real actualScale: 1.0
-        property real offsetX: 0
-        property real offsetY: 0
-        property bool isPainting: false
-
-        onPaint: {
-            // Защита от повторного входа
-            if (isPainting) {
-                console.log("Рендеринг уже выполняется, пропускаем")
-                return
-            }
-
-            isPainting = true
-            console.log("=== Canvas onPaint вызван ===")
-
-            var ctx = getContext("2d")
-
-            if (!ctx) {
-                console.error("Не удалось получить контекст 2D!")
-                isPainting = false
-                return
-            }
-
-            // Очищаем canvas
-            ctx.clearRect(0, 0, width, height)
-
-            // Проверяем наличие данных
-            if (!mapData) {
-                console.warn("mapData не определен!")
-                drawErrorMessage(ctx, "MapData не инициализирован")
-                isPainting = false
-                return
-            }
-
-            if (!mapData.regions || mapData.regions.length === 0) {
-                console.warn("mapData.regions пуст!")
-                drawErrorMessage(ctx, "Нет данных для отображения")
-                isPainting = false
-                return
-            }
-
-            console.log("Регионов для отрисовки:", mapData.regions.length)
-            console.log("Размер canvas:", width, "x", height)
-
-            // Вычисляем масштаб и смещение для центрирования
-            calculateScaleAndOffset()
-
-            // Применяем трансформацию
-            ctx.save()
-            ctx.translate(offsetX, offsetY)
-            ctx.scale(actualScale, actualScale)
-
-            var drawnCount = 0
-            var totalPaths = 0
-
-            // Рисуем каждый регион
-            for (var i = 0; i < mapData.regions.length; i++) {
-                var region = mapData.regions[i]
-
-                if (!region) {
-                    console.warn("Регион", i, "не определен")
-                    continue
-                }
-
-                var paths = region.paths || []
-                totalPaths += paths.length
-
-                if (paths.length === 0) {
-                    continue
-                }
-
-                // Определяем цвет заливки на основе статуса
-                var fillColor = defaultColor
-                var isSelected = mapData.selectedRegion === region.id
-
-                if (region.status === "warning") {
-                    fillColor = isSelected ? warningActiveColor : warningColor
-                } else if (region.status === "danger") {
-                    fillColor = isSelected ? dangerActiveColor : dangerColor
-                } else {
-                    fillColor = isSelected ? defaultActiveColor : defaultColor
-                }
-
-                // Определяем параметры обводки
-                var currentStrokeColor = strokeColor
-                var currentStrokeWidth = strokeWidth
-
-                // Рисуем все пути региона
-                for (var j = 0; j < paths.length; j++) {
-                    var pathDrawn = drawPath(
-                        ctx,
-                        paths[j],
-                        fillColor,
-                        currentStrokeWidth,
-                        currentStrokeColor
-                    )
-
-                    if (pathDrawn) {
-                        drawnCount++
-                    }
-                }
-            }
-
-            console.log("Нарисовано путей:", drawnCount, "из", totalPaths)
-
-            // Восстанавливаем контекст
-            ctx.restore()
-
-            // Снимаем флаг рендеринга
-            isPainting = false
-        }
-
-        // Функция расчета масштаба и смещения для центрирования карты
-        function calculateScaleAndOffset() {
-            var baseMapWidth = 1000
-            var baseMapHeight = 700
-
-            var availableWidth = width
-            var availableHeight = height
-
-            var scaleX = availableWidth / baseMapWidth
-            var scaleY = availableHeight / baseMapHeight
-            actualScale = Math.min(scaleX, scaleY)
-
-            var scaledWidth = baseMapWidth * actualScale
-            var scaledHeight = baseMapHeight * actualScale
-
-            offsetX = (width - scaledWidth) / 2
-            offsetY = (height - scaledHeight) / 2
-        }
-
-        // Функция рисования пути
-        function drawPath(ctx, pathString, fillColor, lineWidth, strokeColor) {
-            if (!pathString || pathString.length === 0) {
-                return false
-            }
-
-            ctx.fillStyle = fillColor
-            ctx.strokeStyle = strokeColor
-            ctx.lineWidth = lineWidth
-
-            ctx.beginPath()
-
-            var tokens = pathString.replace(/([MLZ])/g, "|$1 ").split("|")
-            var hasPoints = false
-
-            for (var i = 0; i < tokens.length; i++) {
-                var token = tokens[i].trim()
-                if (!token) continue
-
-                var parts = token.split(/\s+/)
-                var cmd = parts[0]
-
-                if (cmd === 'M' && parts.length >= 3) {
-                    var mx = parseFloat(parts[1])
-                    var my = parseFloat(parts[2])
-                    if (!isNaN(mx) && !isNaN(my)) {
-                        ctx.moveTo(mx, my)
-                        hasPoints = true
-                    }
-                } else if (cmd === 'L' && parts.length >= 3) {
-                    var lx = parseFloat(parts[1])
-                    var ly = parseFloat(parts[2])
-                    if (!isNaN(lx) && !isNaN(ly)) {
-                        ctx.lineTo(lx, ly)
-                        hasPoints = true
-                    }
-                } else if (cmd === 'Z') {
-                    ctx.closePath()
-                }
-            }
-
-            if (hasPoints) {
-                ctx.fill()
-                if (lineWidth > 0) {
-                    ctx.stroke()
-                }
-                return true
-            }
-
-            return false
-        }
-
-        // Функция отрисовки сообщения об ошибке
-        function drawErrorMessage(ctx, message) {
-            ctx.fillStyle = "#333333"
-            ctx.font = "16px Arial"
-            ctx.textAlign = "center"
-            ctx.textBaseline = "middle"
-            ctx.fillText(message, width / 2, height / 2)
+        // Карта рисуется через scene graph: смена статуса или выбора только
+        // запускает переход цвета в шейдере, геометрия не пересчитывается
+        source: mapData
+
+        defaultColor: mapComponent.defaultColor
+        warningColor: mapComponent.warningColor
+        dangerColor: mapComponent.dangerColor
+        defaultActiveColor: mapComponent.defaultActiveColor
+        warningActiveColor: mapComponent.warningActiveColor
+        dangerActiveColor: mapComponent.dangerActiveColor
+
+        strokeColor: mapComponent.strokeColor
+        strokeWidth: mapComponent.strokeWidth
+
+        transitionDuration: mapComponent.transitionDuration
+        pulsePeriod: mapComponent.pulsePeriod
+        pulseAmplitude: mapComponent.pulseAmplitude
+        pulseColor: mapComponent.pulseColor
+
+        // Сообщение при отсутствии данных
+        Text {
+            anchors.centerIn: parent
+            visible: mapRenderer.regionCount === 0
+            text: typeof mapData === 'undefined' || !mapData ? "MapData не инициализирован"
+                                                             : "Нет данных для отображения"
+            color: "#333333"
+            font.pixelSize: 16
+            font.family: "Arial"
         }
 
         // Обработка кликов и hover
@@ -261,9 +89,9 @@ Item {
                 // ОПТИМИЗАЦИЯ: Используем C++ метод для поиска региона
                 var clickedRegion = mapData.getRegionAtPoint(
                     mouse.x, mouse.y,
-                    mapCanvas.actualScale,
-                    mapCanvas.offsetX,
-                    mapCanvas.offsetY
+                    mapRenderer.actualScale,
+                    mapRenderer.offsetX,
+                    mapRenderer.offsetY
                 )
 
                 if (clickedRegion && clickedRegion.id) {
@@ -301,9 +129,9 @@ Item {
                     // ОПТИМИЗАЦИЯ: Используем C++ метод для поиска региона
                     var hoveredRegion = mapData.getRegionAtPoint(
                         pendingX, pendingY,
-                        mapCanvas.actualScale,
-                        mapCanvas.offsetX,
-                        mapCanvas.offsetY
+                        mapRenderer.actualScale,
+                        mapRenderer.offsetX,
+                        mapRenderer.offsetY
                     )
 
                     if (hoveredRegion && hoveredRegion.id) {
@@ -350,44 +178,20 @@ Item {
 
             onRegionsChanged: {
                 console.log("Сигнал: regionsChanged")
-                // Подготавливаем оптимизированную геометрию для быстрого поиска
+                // Подготавливаем геометрию для поиска и отрисовки (MapRenderer
+                // перестраивает узлы по сигналу geometryPrepared)
                 mapData.prepareRegionGeometry()
-                mapCanvas.requestPaint()
-            }
-
-            onSelectedRegionChanged: {
-                console.log("Сигнал: selectedRegionChanged")
-                if (!mapCanvas.isPainting) {
-                    mapCanvas.requestPaint()
-                }
             }
         }
 
         Component.onCompleted: {
-            console.log("Canvas инициализирован")
-            console.log("Размеры canvas:", width, "x", height)
+            console.log("MapRenderer инициализирован")
             if (mapData) {
                 console.log("MapData доступен, регионов:", mapData.regions ? mapData.regions.length : 0)
                 // Подготавливаем геометрию при инициализации
                 mapData.prepareRegionGeometry()
             } else {
-                console.warn("MapData не доступен при инициализации Canvas!")
-            }
-            requestPaint()
-        }
-
-        // Перерисовка при изменении размера с debounce
-        onWidthChanged: {
-            if (width > 0) {
-                console.log("Canvas width изменился:", width)
-                resizeTimer.restart()
-            }
-        }
-
-        onHeightChanged: {
-            if (height > 0) {
-                console.log("Canvas height изменился:", height)
-                resizeTimer.restart()
+                console.warn("MapData не доступен при инициализации MapRenderer!")
             }
         }
     }
@@ -0,0 +1,629 @@
+#include "statussource.h"
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QQuickWindow>
+#include <QTimer>
+
+namespace {
+
+// Сколько байт начала и конца прочитанной части файла запоминается
+// для обнаружения перезаписи на месте
+const int fileSignatureSize = 64;
+
+// Ограничения входного потока: длина строки и буфер чтения сокета.
+// Пока буфер полон, данные остаются в ядре и запись у клиента блокируется
+const int maxLineLength = 4096;
+const qint64 socketReadBufferSize = 64 * 1024;
+
+// Если кадр после применения пакета не отрисован, подтверждаем по таймауту
+const int frameAckTimeout = 100;
+
+// Счетчики отброшенных обновлений выводятся не чаще одного раза за интервал
+const qint64 statsLogInterval = 5000;
+
+bool isKnownStatus(const QString &status)
+{
+    return status == "default" || status == "warning" || status == "danger";
+}
+
+}
+
+// ============================================================================
+// StatusSourceWorker - работает в отдельном потоке
+// ============================================================================
+
+StatusSourceWorker::StatusSourceWorker(QObject *parent)
+    : QObject(parent),
+      m_watcher(nullptr),
+      m_server(nullptr),
+      m_flushTimer(new QTimer(this)),
+      m_fileOffset(0),
+      m_discardLine(false),
+      m_inFlight(false),
+      m_supersededCount(0),
+      m_rejectedCount(0)
+{
+    // Таймер переезжает в поток вместе с родителем
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(16);
+    connect(m_flushTimer, &QTimer::timeout, this, &StatusSourceWorker::flush);
+}
+
+void StatusSourceWorker::watchFile(const QString &filePath)
+{
+    // Наблюдатель создается здесь, чтобы он принадлежал рабочему потоку
+    if (!m_watcher)
+    {
+        m_watcher = new QFileSystemWatcher(this);
+        connect(m_watcher, &QFileSystemWatcher::fileChanged, this, &StatusSourceWorker::onFileChanged);
+        connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, &StatusSourceWorker::onDirectoryChanged);
+    }
+
+    if (!m_filePath.isEmpty())
+    {
+        m_watcher->removePath(m_filePath);
+        m_watcher->removePath(QFileInfo(m_filePath).absolutePath());
+    }
+
+    m_filePath = QFileInfo(filePath).absoluteFilePath();
+    resetFileState();
+
+    // Следим и за каталогом, чтобы заметить создание или атомарную замену файла
+    m_watcher->addPath(QFileInfo(m_filePath).absolutePath());
+    if (QFile::exists(m_filePath))
+    {
+        m_watcher->addPath(m_filePath);
+        readFile();
+    }
+
+    qDebug() << "Источник статусов: наблюдение за файлом" << m_filePath;
+}
+
+void StatusSourceWorker::listenSocket(const QString &serverName)
+{
+    if (!m_server)
+    {
+        m_server = new QLocalServer(this);
+        connect(m_server, &QLocalServer::newConnection, this, &StatusSourceWorker::onNewConnection);
+    }
+
+    m_server->close();
+
+    bool listening = m_server->listen(serverName);
+
+    // Имя занято: удаляем сокет, только если его никто не обслуживает
+    // (остался после аварийного завершения), иначе не перехватываем чужой поток
+    if (!listening && m_server->serverError() == QAbstractSocket::AddressInUseError)
+    {
+        QLocalSocket probe;
+        probe.connectToServer(serverName);
+        if (probe.waitForConnected(200))
+        {
+            probe.disconnectFromServer();
+            emit sourceError(QString("Локальный сокет %1 уже используется другим процессом")
+                                 .arg(serverName));
+            return;
+        }
+
+        QLocalServer::removeServer(serverName);
+        listening = m_server->listen(serverName);
+    }
+
+    if (!listening)
+    {
+        emit sourceError(QString("Не удалось открыть локальный сокет %1: %2")
+                             .arg(serverName)
+                             .arg(m_server->errorString()));
+        return;
+    }
+
+    qDebug() << "Источник статусов: ожидание подключений на" << m_server->fullServerName();
+}
+
+void StatusSourceWorker::setBaseline(const StatusBatch &snapshot)
+{
+    m_known = snapshot;
+
+    // Отбрасываем ожидающие изменения, которые уже совпадают с новым состоянием
+    StatusBatch::iterator it = m_pending.begin();
+    while (it != m_pending.end())
+    {
+        if (!m_known.contains(it.key()) || m_known.value(it.key()) == it.value())
+            it = m_pending.erase(it);
+        else
+            ++it;
+    }
+}
+
+void StatusSourceWorker::noteStatuses(const StatusBatch &statuses)
+{
+    for (StatusBatch::const_iterator it = statuses.constBegin(); it != statuses.constEnd(); ++it)
+    {
+        if (m_known.contains(it.key()))
+            m_known[it.key()] = it.value();
+    }
+}
+
+void StatusSourceWorker::setMinApplyInterval(int msec)
+{
+    m_flushTimer->setInterval(qMax(0, msec));
+}
+
+void StatusSourceWorker::acknowledgeBatch()
+{
+    m_inFlight = false;
+
+    // Дочитываем строки, накопившиеся в буферах сокетов за время ожидания.
+    // Копия списка: abort() внутри readSocket может удалить сокет из m_sockets
+    const QList<QLocalSocket*> sockets = m_sockets;
+    for (QLocalSocket *socket : sockets)
+    {
+        readSocket(socket);
+    }
+
+    scheduleFlush();
+}
+
+void StatusSourceWorker::onFileChanged()
+{
+    // Файл удален или заменен - ждем его появления через directoryChanged
+    if (!QFile::exists(m_filePath))
+    {
+        resetFileState();
+        return;
+    }
+
+    // После атомарной замены путь пропадает из списка наблюдения
+    if (!m_watcher->files().contains(m_filePath))
+    {
+        m_watcher->addPath(m_filePath);
+        resetFileState();
+    }
+
+    readFile();
+}
+
+void StatusSourceWorker::onDirectoryChanged()
+{
+    if (m_filePath.isEmpty() || m_watcher->files().contains(m_filePath))
+        return;
+
+    if (QFile::exists(m_filePath))
+    {
+        m_watcher->addPath(m_filePath);
+        resetFileState();
+        readFile();
+    }
+}
+
+void StatusSourceWorker::resetFileState()
+{
+    m_fileOffset = 0;
+    m_lineBuffer.clear();
+    m_discardLine = false;
+    m_fileHead.clear();
+    m_fileTail.clear();
+}
+
+// Файл мог быть перезаписан на месте (truncate + write) без уменьшения размера.
+// Проверяем, что начало и конец уже прочитанной части остались прежними
+bool StatusSourceWorker::isFileRewritten(QFile &file) const
+{
+    if (file.size() < m_fileOffset)
+        return true;
+
+    if (m_fileOffset == 0)
+        return false;
+
+    if (!file.seek(0) || file.read(m_fileHead.size()) != m_fileHead)
+        return true;
+
+    if (!file.seek(m_fileOffset - m_fileTail.size()) || file.read(m_fileTail.size()) != m_fileTail)
+        return true;
+
+    return false;
+}
+
+void StatusSourceWorker::readFile()
+{
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        emit sourceError(QString("Не удалось открыть файл статусов: %1").arg(m_filePath));
+        return;
+    }
+
+    // Файл перезаписан - читаем с начала
+    if (isFileRewritten(file))
+    {
+        qDebug() << "Источник статусов: файл перезаписан, чтение с начала";
+        resetFileState();
+    }
+
+    if (!file.seek(m_fileOffset))
+        return;
+
+    QByteArray chunk = file.readAll();
+    file.close();
+
+    m_fileOffset += chunk.size();
+    m_lineBuffer.append(chunk);
+
+    if (m_fileHead.size() < fileSignatureSize)
+        m_fileHead.append(chunk.left(fileSignatureSize - m_fileHead.size()));
+    m_fileTail = (m_fileTail + chunk).right(fileSignatureSize);
+
+    // Остаток слишком длинной строки пропускаем до ее перевода строки
+    if (m_discardLine)
+    {
+        int newline = m_lineBuffer.indexOf('\n');
+        if (newline < 0)
+        {
+            m_lineBuffer.clear();
+            return;
+        }
+        m_lineBuffer.remove(0, newline + 1);
+        m_discardLine = false;
+    }
+
+    // Разбираем только завершенные строки, хвост ждет следующей записи
+    int end = m_lineBuffer.lastIndexOf('\n');
+    if (end >= 0)
+    {
+        const QList<QByteArray> lines = m_lineBuffer.left(end).split('\n');
+        m_lineBuffer.remove(0, end + 1);
+
+        for (const QByteArray &line : lines)
+        {
+            if (line.size() > maxLineLength)
+            {
+                ++m_rejectedCount;
+                continue;
+            }
+            parseLine(line);
+        }
+    }
+
+    // Незавершенная строка не может расти бесконечно: отбрасываем ее целиком,
+    // включая продолжение, которое придет следующими записями
+    if (m_lineBuffer.size() > maxLineLength)
+    {
+        ++m_rejectedCount;
+        m_lineBuffer.clear();
+        m_discardLine = true;
+    }
+
+    scheduleFlush();
+}
+
+void StatusSourceWorker::onNewConnection()
+{
+    while (m_server->hasPendingConnections())
+    {
+        QLocalSocket *socket = m_server->nextPendingConnection();
+        socket->setReadBufferSize(socketReadBufferSize);
+        m_sockets.append(socket);
+
+        connect(socket, &QLocalSocket::readyRead, this, &StatusSourceWorker::onSocketReadyRead);
+        connect(socket, &QLocalSocket::disconnected, this, &StatusSourceWorker::onSocketDisconnected);
+        qDebug() << "Источник статусов: подключен клиент";
+    }
+}
+
+void StatusSourceWorker::onSocketDisconnected()
+{
+    QLocalSocket *socket = qobject_cast<QLocalSocket*>(sender());
+    if (!socket)
+        return;
+
+    // Дочитываем то, что клиент успел записать перед отключением,
+    // даже если пакет еще в пути: после удаления сокета данные пропадут
+    readSocketLines(socket);
+
+    QByteArray tail = socket->readAll();
+    if (tail.size() > maxLineLength)
+        ++m_rejectedCount;
+    else
+        parseLine(tail);
+
+    m_sockets.removeOne(socket);
+    socket->deleteLater();
+    scheduleFlush();
+}
+
+void StatusSourceWorker::onSocketReadyRead()
+{
+    QLocalSocket *socket = qobject_cast<QLocalSocket*>(sender());
+    if (!socket)
+        return;
+
+    readSocket(socket);
+    scheduleFlush();
+}
+
+void StatusSourceWorker::readSocket(QLocalSocket *socket)
+{
+    // Пока GUI не применил пакет, сокет не читаем: буфер заполняется
+    // и клиент упирается в ограничение записи
+    if (m_inFlight)
+        return;
+
+    readSocketLines(socket);
+
+    // Строка без перевода строки длиннее допустимого - клиент неисправен
+    if (socket->bytesAvailable() > maxLineLength)
+    {
+        emit sourceError("Источник статусов: слишком длинная строка, клиент отключен");
+        socket->abort();
+    }
+}
+
+void StatusSourceWorker::readSocketLines(QLocalSocket *socket)
+{
+    while (socket->canReadLine())
+    {
+        QByteArray line = socket->readLine();
+        if (line.size() > maxLineLength)
+        {
+            ++m_rejectedCount;
+            continue;
+        }
+        parseLine(line);
+    }
+}
+
+// Формат строки: {"id": "10312", "status": "warning"} или 10312,warning
+void StatusSourceWorker::parseLine(const QByteArray &rawLine)
+{
+    QByteArray line = rawLine.trimmed();
+    if (line.isEmpty() || line.startsWith('#'))
+        return;
+
+    QString regionId;
+    QString status;
+
+    if (line.startsWith('{'))
+    {
+        QJsonObject object = QJsonDocument::fromJson(line).object();
+        regionId = object.contains("id") ? object["id"].toString()
+                                         : object["hc-key"].toString();
+        status = object["status"].toString();
+    }
+    else
+    {
+        int separator = line.indexOf(',');
+        if (separator < 0)
+            separator = line.indexOf(';');
+        if (separator < 0)
+        {
+            ++m_rejectedCount;
+            return;
+        }
+
+        regionId = QString::fromUtf8(line.left(separator)).trimmed();
+        status = QString::fromUtf8(line.mid(separator + 1)).trimmed();
+    }
+
+    if (regionId.isEmpty() || !isKnownStatus(status))
+    {
+        ++m_rejectedCount;
+        return;
+    }
+
+    queueUpdate(regionId, status);
+}
+
+void StatusSourceWorker::queueUpdate(const QString &regionId, const QString &status)
+{
+    if (!m_known.contains(regionId))
+    {
+        ++m_rejectedCount;
+        return;
+    }
+
+    if (m_pending.contains(regionId))
+    {
+        ++m_supersededCount;
+    }
+
+    // Сравниваем с уже отправленным состоянием: возврат к нему отменяет изменение
+    if (m_known.value(regionId) == status)
+        m_pending.remove(regionId);
+    else
+        m_pending.insert(regionId, status);
+}
+
+void StatusSourceWorker::scheduleFlush()
+{
+    // Пока GUI не применил предыдущий пакет, изменения копятся в m_pending
+    if (m_inFlight || m_pending.isEmpty() || m_flushTimer->isActive())
+        return;
+
+    m_flushTimer->start();
+}
+
+void StatusSourceWorker::flush()
+{
+    if (m_inFlight || m_pending.isEmpty())
+        return;
+
+    StatusBatch batch;
+    for (StatusBatch::const_iterator it = m_pending.constBegin(); it != m_pending.constEnd(); ++it)
+    {
+        if (m_known.value(it.key()) != it.value())
+        {
+            batch.insert(it.key(), it.value());
+            m_known[it.key()] = it.value();
+        }
+    }
+    m_pending.clear();
+
+    bool statsDue = !m_statsClock.isValid() || m_statsClock.elapsed() >= statsLogInterval;
+    if (statsDue && (m_supersededCount > 0 || m_rejectedCount > 0))
+    {
+        qDebug() << "Источник статусов: отброшено устаревших обновлений" << m_supersededCount
+                 << ", некорректных строк" << m_rejectedCount;
+        m_supersededCount = 0;
+        m_rejectedCount = 0;
+        m_statsClock.start();
+    }
+
+    if (batch.isEmpty())
+        return;
+
+    m_inFlight = true;
+    emit batchReady(batch);
+}
+
+// ============================================================================
+// StatusSource - сторона GUI потока
+// ============================================================================
+
+StatusSource::StatusSource(MapData *mapData, QObject *parent)
+    : QObject(parent),
+      m_mapData(mapData),
+      m_applyingBatch(false),
+      m_ackPending(false),
+      m_worker(new StatusSourceWorker)
+{
+    qRegisterMetaType<StatusBatch>("StatusBatch");
+
+    m_ackTimer.setSingleShot(true);
+    m_ackTimer.setInterval(frameAckTimeout);
+    connect(&m_ackTimer, &QTimer::timeout, this, &StatusSource::acknowledgeBatch);
+
+    m_worker->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+
+    connect(m_worker, &StatusSourceWorker::batchReady, this, &StatusSource::applyBatch);
+    connect(m_worker, &StatusSourceWorker::sourceError, this, &StatusSource::sourceError);
+
+    if (m_mapData)
+    {
+        // Изменения из других мест (updateRegionStatus) учитываются при сравнении
+        connect(m_mapData, &MapData::regionStatusesChanged, this, &StatusSource::onRegionStatusesChanged);
+        connect(m_mapData, &MapData::regionsChanged, this, &StatusSource::resyncBaseline);
+    }
+
+    m_thread.setObjectName("StatusSource");
+    m_thread.start();
+
+    resyncBaseline();
+}
+
+StatusSource::~StatusSource()
+{
+    m_thread.quit();
+    m_thread.wait();
+}
+
+void StatusSource::watchFile(const QString &filePath)
+{
+    StatusSourceWorker *worker = m_worker;
+    QMetaObject::invokeMethod(worker, [worker, filePath]() {
+        worker->watchFile(filePath);
+    }, Qt::QueuedConnection);
+}
+
+void StatusSource::listenSocket(const QString &serverName)
+{
+    StatusSourceWorker *worker = m_worker;
+    QMetaObject::invokeMethod(worker, [worker, serverName]() {
+        worker->listenSocket(serverName);
+    }, Qt::QueuedConnection);
+}
+
+void StatusSource::setMinApplyInterval(int msec)
+{
+    StatusSourceWorker *worker = m_worker;
+    QMetaObject::invokeMethod(worker, [worker, msec]() {
+        worker->setMinApplyInterval(msec);
+    }, Qt::QueuedConnection);
+}
+
+void StatusSource::applyBatch(const StatusBatch &batch)
+{
+    int changed = 0;
+    if (m_mapData)
+    {
+        m_applyingBatch = true;
+        changed = m_mapData->applyStatusBatch(batch);
+        m_applyingBatch = false;
+    }
+
+    emit batchApplied(changed);
+
+    // Следующий пакет - после отрисовки кадра с этими изменениями
+    if (changed > 0 && m_renderWindow)
+    {
+        m_ackPending = true;
+        m_ackTimer.start();
+        m_renderWindow->update();
+        return;
+    }
+
+    m_ackPending = true;
+    acknowledgeBatch();
+}
+
+void StatusSource::setRenderWindow(QQuickWindow *window)
+{
+    if (m_renderWindow)
+        disconnect(m_renderWindow, nullptr, this, nullptr);
+
+    m_renderWindow = window;
+
+    if (m_renderWindow)
+        connect(m_renderWindow, &QQuickWindow::afterRendering, this, &StatusSource::acknowledgeBatch);
+}
+
+void StatusSource::acknowledgeBatch()
+{
+    if (!m_ackPending)
+        return;
+
+    m_ackPending = false;
+    m_ackTimer.stop();
+
+    // Разрешаем рабочему потоку отправить следующий пакет
+    StatusSourceWorker *worker = m_worker;
+    QMetaObject::invokeMethod(worker, [worker]() {
+        worker->acknowledgeBatch();
+    }, Qt::QueuedConnection);
+}
+
+void StatusSource::resyncBaseline()
+{
+    if (!m_mapData)
+        return;
+
+    StatusBatch snapshot = m_mapData->statusSnapshot();
+    StatusSourceWorker *worker = m_worker;
+    QMetaObject::invokeMethod(worker, [worker, snapshot]() {
+        worker->setBaseline(snapshot);
+    }, Qt::QueuedConnection);
+}
+
+void StatusSource::onRegionStatusesChanged(const QStringList &regionIds)
+{
+    // Статусы из собственного пакета воркер уже учел в flush()
+    if (m_applyingBatch || !m_mapData)
+        return;
+
+    StatusBatch statuses;
+    for (const QString &regionId : regionIds)
+    {
+        statuses.insert(regionId, m_mapData->regionStatus(regionId));
+    }
+
+    StatusSourceWorker *worker = m_worker;
+    QMetaObject::invokeMethod(worker, [worker, statuses]() {
+        worker->noteStatuses(statuses);
+    }, Qt::QueuedConnection);
+}
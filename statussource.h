@@ -0,0 +1,120 @@
+#ifndef STATUSSOURCE_H
+#define STATUSSOURCE_H
+
+#include <QObject>
+#include <QPointer>
+#include <QThread>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QTimer>
+#include "mapdata.h"
+
+class QFile;
+class QFileSystemWatcher;
+class QLocalServer;
+class QLocalSocket;
+class QQuickWindow;
+
+// Рабочий объект источника статусов. Живет в отдельном потоке:
+// читает файл/сокет, разбирает строки JSON/CSV, сравнивает с известным
+// состоянием и отдает в GUI только изменившиеся регионы одним пакетом.
+class StatusSourceWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit StatusSourceWorker(QObject *parent = nullptr);
+
+public slots:
+    void watchFile(const QString &filePath);
+    void listenSocket(const QString &serverName);
+    void setBaseline(const StatusBatch &snapshot);
+    void noteStatuses(const StatusBatch &statuses);
+    void setMinApplyInterval(int msec);
+
+    // Подтверждение от GUI, что предыдущий пакет применен
+    void acknowledgeBatch();
+
+signals:
+    void batchReady(const StatusBatch &batch);
+    void sourceError(const QString &message);
+
+private slots:
+    void onFileChanged();
+    void onDirectoryChanged();
+    void onNewConnection();
+    void onSocketReadyRead();
+    void onSocketDisconnected();
+    void flush();
+
+private:
+    void readFile();
+    void resetFileState();
+    bool isFileRewritten(QFile &file) const;
+    void readSocket(QLocalSocket *socket);
+    void readSocketLines(QLocalSocket *socket);
+    void parseLine(const QByteArray &rawLine);
+    void queueUpdate(const QString &regionId, const QString &status);
+    void scheduleFlush();
+
+    QFileSystemWatcher *m_watcher;
+    QLocalServer *m_server;
+    QList<QLocalSocket*> m_sockets;
+    QTimer *m_flushTimer;
+
+    QString m_filePath;
+    qint64 m_fileOffset;
+    QByteArray m_lineBuffer; // Незавершенная последняя строка файла
+    bool m_discardLine;      // Пропускать данные до следующего перевода строки
+    QByteArray m_fileHead;   // Начало и конец уже прочитанной части файла
+    QByteArray m_fileTail;
+
+    StatusBatch m_known;   // Состояние, уже отправленное в GUI
+    StatusBatch m_pending; // Накопленные изменения (последнее значение побеждает)
+    bool m_inFlight;       // Пакет отправлен, но еще не применен
+
+    int m_supersededCount;
+    int m_rejectedCount;
+    QElapsedTimer m_statsClock; // Время последнего вывода счетчиков
+};
+
+// Источник статусов регионов из локального файла или локального сокета.
+// Разбор входных данных выполняется вне GUI потока; в GUI поток попадают
+// только готовые пакеты изменений, не чаще одного за minApplyInterval.
+class StatusSource : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit StatusSource(MapData *mapData, QObject *parent = nullptr);
+    ~StatusSource();
+
+    Q_INVOKABLE void watchFile(const QString &filePath);
+    Q_INVOKABLE void listenSocket(const QString &serverName);
+    void setMinApplyInterval(int msec);
+
+    // Окно, после отрисовки кадра которого подтверждается пакет
+    void setRenderWindow(QQuickWindow *window);
+
+signals:
+    void batchApplied(int changedCount);
+    void sourceError(const QString &message);
+
+private slots:
+    void applyBatch(const StatusBatch &batch);
+    void resyncBaseline();
+    void onRegionStatusesChanged(const QStringList &regionIds);
+    void acknowledgeBatch();
+
+private:
+    QPointer<MapData> m_mapData;
+    bool m_applyingBatch; // Изменения от собственного пакета воркеру не пересылаются
+    QPointer<QQuickWindow> m_renderWindow;
+    QTimer m_ackTimer;
+    bool m_ackPending;
+    QThread m_thread;
+    StatusSourceWorker *m_worker;
+};
+
+#endif // STATUSSOURCE_H